@@ -0,0 +1,125 @@
+//
+// new_mpc with the model template cache from model_cache.h.
+//
+// Usage: cached_mpc [--no-cache] [--record dir] [cache_dir]
+//
+// Measures cold-start-to-first-solution time: from entering main until the
+// first solve returns. Run it a few times with and without --no-cache to
+// compare; the first cached run is a miss that writes the cache entry.
+// --record dir records the solved instance for tune_params, as new_mpc does.
+//
+#include "gurobi_c++.h"
+#include "model_cache.h"
+#include "nmpc_model.h"
+#include "param_profile.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+int main(int argc, char* argv[]) {
+    auto process_start = std::chrono::high_resolution_clock::now();
+
+    bool use_cache = true;
+    std::string cache_dir = "cache";
+    std::string record_dir;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--no-cache") == 0) {
+            use_cache = false;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_dir = argv[++i];
+        } else {
+            cache_dir = argv[i];
+        }
+    }
+
+    try {
+        GRBEnv env = GRBEnv(true);
+        env.start();
+
+        // Gurobi parameters
+        env.set("MIPFocus", "1");
+        env.set("MIPGap", "0.01");
+        env.set("TimeLimit", "600");
+        env.set("Threads", "0");
+        env.set("PreSolve", "2");
+        env.set("Cuts", "2");
+        env.set("FuncNonlinear", "1");
+
+        NmpcStructure s;
+        s.N = 20;
+        s.num_obstacles = 1;
+
+        // Per-run data, the only thing patched into a cached model
+        double x_start[4] = {0, 0, M_PI_4, 0};  // Start state (x, y, theta, v)
+        double x_goal[4] = {5, 5, M_PI_4, 0};  // Goal state (x, y, theta, v)
+        std::vector<Obstacle> obstacles = {
+                {2, 2, 1}
+        };
+
+        // Own class: the cached model (with dx/dy offsets) is not the model
+        // new_mpc profiles were tuned on
+        std::string problem_class = problemClass("cached_mpc", s.N, s.num_obstacles);
+        loadParamProfile(env, problem_class);
+
+        auto setup_start = std::chrono::high_resolution_clock::now();
+
+        bool hit = false;
+        std::unique_ptr<GRBModel> model;
+        if (use_cache) {
+            model = loadOrBuildModel(env, s, cache_dir, hit);
+        } else {
+            model.reset(new GRBModel(env));
+            buildNmpcModel(*model, s);
+        }
+
+        NmpcHandles h = getHandles(*model);
+        setInitialState(*model, h, s, x_start);
+        setGoal(*model, h, s, x_goal);
+        setObstacles(*model, h, s, obstacles);
+
+        auto setup_end = std::chrono::high_resolution_clock::now();
+
+        // Optimize the model
+        model->optimize();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> setup = setup_end - setup_start;
+        std::chrono::duration<double> solve = end - setup_end;
+        std::chrono::duration<double> total = end - process_start;
+        std::cout << "Model setup (" << (use_cache ? (hit ? "cache hit" : "cache miss") : "no cache") << "): "
+                  << setup.count() << " seconds" << std::endl;
+        std::cout << "Optimization time: " << solve.count() << " seconds" << std::endl;
+        std::cout << "Cold start to first solution: " << total.count() << " seconds" << std::endl;
+
+        // Output the results
+        NmpcIndex idx(s);
+        if (model->get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
+            std::cout << "Optimal path found!" << std::endl;
+            for (int k = 0; k <= s.N; ++k) {
+                std::cout << "State at step " << k << ": ("
+                          << h.vars[idx.x(k)].get(GRB_DoubleAttr_X) << ", "
+                          << h.vars[idx.y(k)].get(GRB_DoubleAttr_X) << ", "
+                          << h.vars[idx.theta(k)].get(GRB_DoubleAttr_X) << ", "
+                          << h.vars[idx.v(k)].get(GRB_DoubleAttr_X) << ")" << std::endl;
+            }
+        } else {
+            std::cout << "No optimal solution found." << std::endl;
+        }
+
+        // Record the instance for offline tuning
+        if (!record_dir.empty()) {
+            recordInstance(*model, record_dir, problem_class, s.N, s.num_obstacles, solve.count());
+        }
+    } catch (GRBException& e) {
+        std::cerr << "Error code = " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Exception during optimization." << std::endl;
+    }
+    return 0;
+}
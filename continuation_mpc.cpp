@@ -0,0 +1,250 @@
+//
+// Coarse-to-fine continuation for the new_mpc problem.
+//
+// Usage: continuation_mpc [pairs] [seed]
+//
+// The staged solve first solves the same horizon with a 4x larger step and 4x
+// fewer steps, interpolates that trajectory onto the fine grid, and uses it
+// as the start vector and to bound x, y and theta per step around it. If the
+// bounded fine solve ends without a solution the bounds are dropped and it is
+// solved again. If its solution touches the box, it is only optimal for the
+// restricted problem, so the bounds are dropped too and the fine problem is
+// re-solved starting from that solution. Total time (model building included)
+// is compared against a direct fine solve over randomized start/goal pairs.
+//
+#include "gurobi_c++.h"
+#include "nmpc_model.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+struct SolveResult {
+    double time;
+    int status;
+    double objective;
+    bool relaxed;  // Staged solve only: no solution inside the box, bounds dropped
+    bool box_active;  // Staged solve only: the boxed solution sat on a bound, re-solved without it
+};
+
+static const int kRatio = 4;  // Coarse step = kRatio * fine step
+static const double kPosBound = 1.0;  // Allowed deviation from the coarse path (m)
+static const double kThetaBound = 0.5;  // Allowed heading deviation (rad)
+static const double kBoxTol = 1e-6;  // A value this close to a box bound counts as on it
+
+static void patchData(GRBModel& model, const NmpcHandles& h, const NmpcStructure& s, const double x0[4],
+                      const double goal[4], const std::vector<Obstacle>& obstacles) {
+    setInitialState(model, h, s, x0);
+    setGoal(model, h, s, goal);
+    setObstacles(model, h, s, obstacles);
+}
+
+static SolveResult result(GRBModel& model, Clock::time_point start) {
+    SolveResult r;
+    r.time = seconds(start);
+    r.status = model.get(GRB_IntAttr_Status);
+    r.objective = model.get(GRB_IntAttr_SolCount) > 0 ? model.get(GRB_DoubleAttr_ObjVal) : GRB_INFINITY;
+    r.relaxed = false;
+    r.box_active = false;
+    return r;
+}
+
+static SolveResult solveDirect(GRBEnv& env, const NmpcStructure& s, const double x0[4], const double goal[4],
+                               const std::vector<Obstacle>& obstacles) {
+    auto start = Clock::now();
+    GRBModel model = GRBModel(env);
+    buildNmpcModel(model, s);
+    NmpcHandles h = getHandles(model);
+    patchData(model, h, s, x0, goal, obstacles);
+    model.optimize();
+    return result(model, start);
+}
+
+static SolveResult solveStaged(GRBEnv& env, const NmpcStructure& s, const double x0[4], const double goal[4],
+                               const std::vector<Obstacle>& obstacles) {
+    auto start = Clock::now();
+
+    // Same horizon length in time; stage weights scale with the step so the
+    // coarse sums approximate the same cost
+    NmpcStructure cs = s;
+    cs.N = s.N / kRatio;
+    cs.T = s.T * kRatio;
+    for (int i = 0; i < 4; ++i) cs.Q[i] *= kRatio;
+    for (int i = 0; i < 2; ++i) cs.R[i] *= kRatio;
+
+    GRBModel coarse = GRBModel(env);
+    buildNmpcModel(coarse, cs);
+    NmpcHandles ch = getHandles(coarse);
+    patchData(coarse, ch, cs, x0, goal, obstacles);
+    coarse.optimize();
+
+    GRBModel model = GRBModel(env);
+    buildNmpcModel(model, s);
+    NmpcHandles h = getHandles(model);
+    patchData(model, h, s, x0, goal, obstacles);
+
+    bool bounded = false, box_active = false;
+    NmpcIndex idx(s);
+    if (coarse.get(GRB_IntAttr_SolCount) > 0) {
+        NmpcIndex cidx(cs);
+        double* cx = coarse.get(GRB_DoubleAttr_X, ch.vars.data(), (int) ch.vars.size());
+
+        // States are interpolated linearly, controls held over each coarse step
+        std::vector<double> guess(idx.numVars());
+        for (int k = 0; k <= s.N; ++k) {
+            int c = std::min(k / kRatio, cs.N - 1);
+            double w = (double) k / kRatio - c;
+            for (int i = 0; i < 4; ++i) {
+                guess[idx.x(k) + i] = (1 - w) * cx[cidx.x(c) + i] + w * cx[cidx.x(c + 1) + i];
+            }
+        }
+        for (int k = 0; k < s.N; ++k) {
+            int c = std::min(k / kRatio, cs.N - 1);
+            double theta = guess[idx.theta(k)];
+            double steer = cx[cidx.steer(c)];
+            guess[idx.steer(k)] = steer;
+            guess[idx.a(k)] = cx[cidx.a(c)];
+            guess[idx.cosTheta(k)] = std::cos(theta);
+            guess[idx.sinTheta(k)] = std::sin(theta);
+            guess[idx.tanSteer(k)] = std::tan(steer);
+            for (int j = 0; j < s.num_obstacles; ++j) {
+                guess[idx.dx(k, j)] = guess[idx.x(k)] - obstacles[j].x;
+                guess[idx.dy(k, j)] = guess[idx.y(k)] - obstacles[j].y;
+            }
+        }
+        delete[] cx;
+        model.set(GRB_DoubleAttr_Start, h.vars.data(), guess.data(), (int) guess.size());
+
+        // Per-step box around the coarse path; x0 is fixed by its constraint anyway
+        std::vector<GRBVar> vars;
+        std::vector<double> lb, ub;
+        for (int k = 1; k <= s.N; ++k) {
+            int cols[3] = {idx.x(k), idx.y(k), idx.theta(k)};
+            double width[3] = {kPosBound, kPosBound, kThetaBound};
+            for (int i = 0; i < 3; ++i) {
+                vars.push_back(h.vars[cols[i]]);
+                lb.push_back(guess[cols[i]] - width[i]);
+                ub.push_back(guess[cols[i]] + width[i]);
+            }
+        }
+        model.set(GRB_DoubleAttr_LB, vars.data(), lb.data(), (int) vars.size());
+        model.set(GRB_DoubleAttr_UB, vars.data(), ub.data(), (int) vars.size());
+        bounded = true;
+
+        model.optimize();
+        if (model.get(GRB_IntAttr_SolCount) > 0) {
+            double* val = model.get(GRB_DoubleAttr_X, vars.data(), (int) vars.size());
+            for (size_t i = 0; i < vars.size(); ++i) {
+                box_active = box_active || val[i] <= lb[i] + kBoxTol || val[i] >= ub[i] - kBoxTol;
+            }
+            delete[] val;
+            if (!box_active) {
+                return result(model, start);
+            }
+
+            // On the box: warm start the unbounded problem from this solution
+            double* x = model.get(GRB_DoubleAttr_X, h.vars.data(), (int) h.vars.size());
+            model.set(GRB_DoubleAttr_Start, h.vars.data(), x, (int) h.vars.size());
+            delete[] x;
+        }
+
+        // No solution inside the box (infeasible, or none found within the
+        // time limit) or one on its boundary, fall back to the unbounded problem
+        std::vector<double> free_lb(vars.size(), -GRB_INFINITY), free_ub(vars.size(), GRB_INFINITY);
+        model.set(GRB_DoubleAttr_LB, vars.data(), free_lb.data(), (int) vars.size());
+        model.set(GRB_DoubleAttr_UB, vars.data(), free_ub.data(), (int) vars.size());
+    }
+
+    model.optimize();
+    SolveResult r = result(model, start);
+    r.relaxed = bounded && !box_active;
+    r.box_active = box_active;
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    int pairs = argc > 1 ? std::atoi(argv[1]) : 10;
+    unsigned seed = argc > 2 ? (unsigned) std::atoi(argv[2]) : 1;
+
+    try {
+        GRBEnv env = GRBEnv(true);
+        env.set("OutputFlag", "0");
+        env.start();
+
+        // Gurobi parameters
+        env.set("MIPFocus", "1");
+        env.set("MIPGap", "0.01");
+        env.set("TimeLimit", "120");
+        env.set("Threads", "0");
+        env.set("PreSolve", "2");
+        env.set("Cuts", "2");
+        env.set("FuncNonlinear", "1");
+
+        NmpcStructure s;
+        s.N = 20;
+        if (s.N % kRatio != 0) {
+            std::cerr << "N must be a multiple of " << kRatio << std::endl;
+            return 1;
+        }
+
+        // Define obstacles
+        std::vector<Obstacle> obstacles = {
+                {2, 2, 1}
+        };
+        s.num_obstacles = (int) obstacles.size();
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> start_pos(-2, 1), goal_pos(3, 7);
+        std::uniform_real_distribution<double> heading(-M_PI_4, 3 * M_PI_4);
+
+        double direct_total = 0, staged_total = 0;
+        int relaxed = 0, box_active = 0, done = 0;
+        while (done < pairs) {
+            double x_start[4] = {start_pos(rng), start_pos(rng), heading(rng), 0};
+            double x_goal[4] = {goal_pos(rng), goal_pos(rng), heading(rng), 0};
+
+            // Skip pairs that start or end inside an obstacle's clearance
+            bool blocked = false;
+            for (const auto& o : obstacles) {
+                double r = o.radius + s.margin;
+                blocked = blocked || std::hypot(x_start[0] - o.x, x_start[1] - o.y) < r ||
+                          std::hypot(x_goal[0] - o.x, x_goal[1] - o.y) < r;
+            }
+            if (blocked) {
+                continue;
+            }
+
+            SolveResult direct = solveDirect(env, s, x_start, x_goal, obstacles);
+            SolveResult staged = solveStaged(env, s, x_start, x_goal, obstacles);
+            std::cout << "Pair " << done << ": direct " << direct.time << " s (obj " << direct.objective
+                      << ", status " << direct.status << "), staged " << staged.time << " s (obj "
+                      << staged.objective << ", status " << staged.status
+                      << (staged.relaxed ? ", bounds relaxed" : "")
+                      << (staged.box_active ? ", box active" : "") << ")" << std::endl;
+            direct_total += direct.time;
+            staged_total += staged.time;
+            relaxed += staged.relaxed ? 1 : 0;
+            box_active += staged.box_active ? 1 : 0;
+            done++;
+        }
+
+        std::cout << "Total over " << pairs << " pairs: direct " << direct_total << " s, staged "
+                  << staged_total << " s (" << relaxed << " needed the bounds relaxed, " << box_active
+                  << " had the box active and were re-solved without it)" << std::endl;
+    } catch (GRBException& e) {
+        std::cerr << "Error code = " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    } catch (...) {
+        std::cerr << "Exception during optimization." << std::endl;
+    }
+    return 0;
+}
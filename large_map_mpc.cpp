@@ -0,0 +1,279 @@
+//
+// new_mpc on a large obstacle map, with the obstacles pre-filtered per horizon
+// step through the uniform grid in obstacle_grid.h.
+//
+// Usage: large_map_mpc [--full] [--circles file | --grid file] [count]
+//
+// Without a map file a random map of count circles (default 20000) is used.
+// The "reach" model only gets the obstacles reachable from x0 at each step.
+// The "corridor" model then keeps only the obstacles within T * v_max of the
+// reach solution's (x_k, y_k), like a live loop filtering around its previous
+// trajectory. After each solve the trajectory is checked against the whole map
+// and any violated obstacle is added before solving again, which is what keeps
+// the corridor filter safe. --full also solves the model with every obstacle
+// at every step, as new_mpc does, for comparison.
+//
+#include "gurobi_c++.h"
+#include "nmpc_model.h"
+#include "obstacle_grid.h"
+#include <iostream>
+#include <vector>
+#include <set>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+struct SolveStats {
+    int initial_qconstrs, num_qconstrs;  // Before and after adding violated obstacles
+    double build_time, solve_time;
+    int rounds;
+    int status;
+    std::vector<std::pair<double, double>> trajectory;  // (x_k, y_k), k < N
+};
+
+static std::vector<Obstacle> randomMap(int count, const double x_start[4], const double x_goal[4], double margin) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> pos(-100, 100);
+    std::uniform_real_distribution<double> rad(0.1, 0.3);
+    std::vector<Obstacle> obstacles;
+    while ((int) obstacles.size() < count) {
+        Obstacle o = {pos(rng), pos(rng), rad(rng)};
+        double clear = o.radius + margin + 0.5;  // Keep start and goal free
+        if (std::hypot(o.x - x_start[0], o.y - x_start[1]) < clear ||
+            std::hypot(o.x - x_goal[0], o.y - x_goal[1]) < clear) {
+            continue;
+        }
+        obstacles.push_back(o);
+    }
+    return obstacles;
+}
+
+static SolveStats solveOnMap(GRBEnv& env, const NmpcStructure& s, const ObstacleGrid& grid,
+                             const std::vector<std::vector<int>>& per_step,
+                             const double x_start[4], const double x_goal[4]) {
+    const int N = s.N;
+    const std::vector<Obstacle>& obstacles = grid.obstacles();
+    auto build_start = std::chrono::high_resolution_clock::now();
+
+    GRBModel model = GRBModel(env);
+
+    // Define state and control variables
+    std::vector<GRBVar> x_vars(N+1), y_vars(N+1), theta_vars(N+1), v_vars(N+1);
+    std::vector<GRBVar> steer_vars(N), a_vars(N);
+    std::vector<GRBVar> cos_theta_vars(N), sin_theta_vars(N), tan_steer_vars(N);
+
+    for (int k = 0; k <= N; ++k) {
+        x_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "x_" + std::to_string(k));
+        y_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "y_" + std::to_string(k));
+        theta_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "theta_" + std::to_string(k));
+        v_vars[k] = model.addVar(s.v_min, s.v_max, 0, GRB_CONTINUOUS, "v_" + std::to_string(k));
+    }
+
+    for (int k = 0; k < N; ++k) {
+        steer_vars[k] = model.addVar(s.steer_min, s.steer_max, 0, GRB_CONTINUOUS, "steer_" + std::to_string(k));
+        a_vars[k] = model.addVar(s.a_min, s.a_max, 0, GRB_CONTINUOUS, "a_" + std::to_string(k));
+        cos_theta_vars[k] = model.addVar(-1, 1, 0, GRB_CONTINUOUS, "cos_theta_" + std::to_string(k));
+        sin_theta_vars[k] = model.addVar(-1, 1, 0, GRB_CONTINUOUS, "sin_theta_" + std::to_string(k));
+        tan_steer_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "tan_steer_" + std::to_string(k));
+    }
+
+    // Set initial state constraint
+    model.addConstr(x_vars[0] == x_start[0]);
+    model.addConstr(y_vars[0] == x_start[1]);
+    model.addConstr(theta_vars[0] == x_start[2]);
+    model.addConstr(v_vars[0] == x_start[3]);
+
+    // Only the obstacles kept for a step become clearance constraints
+    std::vector<std::set<int>> active(N);
+    auto addClearance = [&](int k, int id) {
+        const Obstacle& o = obstacles[id];
+        double r = o.radius + s.margin;
+        model.addQConstr((x_vars[k] - o.x) * (x_vars[k] - o.x) +
+                         (y_vars[k] - o.y) * (y_vars[k] - o.y) >= r * r);
+        active[k].insert(id);
+    };
+
+    GRBQuadExpr obj = 0;
+
+    for (int k = 0; k < N; ++k) {
+        // Trigonometric constraints using Gurobi's built-in functions
+        model.addGenConstrCos(theta_vars[k], cos_theta_vars[k], "cos_theta_" + std::to_string(k));
+        model.addGenConstrSin(theta_vars[k], sin_theta_vars[k], "sin_theta_" + std::to_string(k));
+        model.addGenConstrTan(steer_vars[k], tan_steer_vars[k], "tan_steer_" + std::to_string(k));
+
+        // Dynamics constraints
+        model.addQConstr(x_vars[k+1] == x_vars[k] + s.T * v_vars[k] * cos_theta_vars[k]);
+        model.addQConstr(y_vars[k+1] == y_vars[k] + s.T * v_vars[k] * sin_theta_vars[k]);
+        model.addQConstr(theta_vars[k+1] == theta_vars[k] + s.T * (v_vars[k] / s.L) * tan_steer_vars[k]);
+        model.addConstr(v_vars[k+1] == v_vars[k] + s.T * a_vars[k]);
+
+        for (int id : per_step[k]) {
+            addClearance(k, id);
+        }
+
+        // Cost function for states and controls
+        obj += (x_vars[k] - x_goal[0]) * (x_vars[k] - x_goal[0]) * s.Q[0] +
+               (y_vars[k] - x_goal[1]) * (y_vars[k] - x_goal[1]) * s.Q[1] +
+               theta_vars[k] * theta_vars[k] * s.Q[2] +
+               v_vars[k] * v_vars[k] * s.Q[3] +
+               steer_vars[k] * steer_vars[k] * s.R[0] +
+               a_vars[k] * a_vars[k] * s.R[1];
+    }
+
+    // Terminal cost
+    obj += (x_vars[N] - x_goal[0]) * (x_vars[N] - x_goal[0]) * s.Q_f[0] +
+           (y_vars[N] - x_goal[1]) * (y_vars[N] - x_goal[1]) * s.Q_f[1] +
+           (theta_vars[N] - x_goal[2]) * (theta_vars[N] - x_goal[2]) * s.Q_f[2] +
+           (v_vars[N] - x_goal[3]) * (v_vars[N] - x_goal[3]) * s.Q_f[3];
+
+    model.setObjective(obj, GRB_MINIMIZE);
+    model.update();
+
+    SolveStats stats;
+    stats.build_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - build_start).count();
+    stats.solve_time = 0;
+    stats.rounds = 0;
+    stats.initial_qconstrs = model.get(GRB_IntAttr_NumQConstrs);
+
+    // Solve, then add every obstacle the trajectory violates and solve again
+    std::vector<int> near;
+    while (true) {
+        auto start = std::chrono::high_resolution_clock::now();
+        model.optimize();
+        stats.solve_time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        stats.rounds++;
+        if (model.get(GRB_IntAttr_SolCount) == 0) {
+            break;
+        }
+
+        int added = 0;
+        for (int k = 0; k < N; ++k) {
+            double x = x_vars[k].get(GRB_DoubleAttr_X);
+            double y = y_vars[k].get(GRB_DoubleAttr_X);
+            near.clear();
+            grid.query(x, y, s.margin, near);
+            for (int id : near) {
+                const Obstacle& o = obstacles[id];
+                double r = o.radius + s.margin;
+                if (!active[k].count(id) && (o.x - x) * (o.x - x) + (o.y - y) * (o.y - y) < r * r - 1e-6) {
+                    addClearance(k, id);
+                    added++;
+                }
+            }
+        }
+        if (added == 0) {
+            break;
+        }
+    }
+
+    stats.num_qconstrs = model.get(GRB_IntAttr_NumQConstrs);
+    stats.status = model.get(GRB_IntAttr_Status);
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        for (int k = 0; k < N; ++k) {
+            stats.trajectory.push_back(std::make_pair(x_vars[k].get(GRB_DoubleAttr_X),
+                                                      y_vars[k].get(GRB_DoubleAttr_X)));
+        }
+    }
+    return stats;
+}
+
+static void printStats(const char* label, const SolveStats& stats) {
+    std::cout << label << ": " << stats.initial_qconstrs << " -> " << stats.num_qconstrs
+              << " quadratic constraints, build "
+              << stats.build_time << " s, solve " << stats.solve_time << " s, "
+              << stats.rounds << " solve rounds, status " << stats.status << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    bool full = false;
+    std::string circles_file, grid_file;
+    int count = 20000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--full") == 0) {
+            full = true;
+        } else if (std::strcmp(argv[i], "--circles") == 0 && i + 1 < argc) {
+            circles_file = argv[++i];
+        } else if (std::strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid_file = argv[++i];
+        } else {
+            count = std::atoi(argv[i]);
+        }
+    }
+
+    try {
+        GRBEnv env = GRBEnv(true);
+        env.start();
+
+        // Gurobi parameters
+        env.set("MIPFocus", "1");
+        env.set("MIPGap", "0.01");
+        env.set("TimeLimit", "600");
+        env.set("Threads", "0");
+        env.set("PreSolve", "2");
+        env.set("Cuts", "2");
+        env.set("FuncNonlinear", "1");
+
+        NmpcStructure s;
+        s.N = 20;
+        s.margin = 0.3;
+
+        double x_start[4] = {0, 0, M_PI_4, 0};  // Start state (x, y, theta, v)
+        double x_goal[4] = {5, 5, M_PI_4, 0};  // Goal state (x, y, theta, v)
+
+        auto load_start = std::chrono::high_resolution_clock::now();
+        std::vector<Obstacle> obstacles;
+        if (!grid_file.empty()) {
+            obstacles = loadOccupancyGrid(grid_file);
+        } else if (!circles_file.empty()) {
+            obstacles = loadCircles(circles_file);
+        } else {
+            obstacles = randomMap(count, x_start, x_goal, s.margin);
+        }
+        ObstacleGrid grid(obstacles, 2.0);
+        std::chrono::duration<double> load = std::chrono::high_resolution_clock::now() - load_start;
+        std::cout << "Loaded " << obstacles.size() << " obstacles and built the grid in "
+                  << load.count() << " seconds" << std::endl;
+
+        // Everything the vehicle can reach from x0 by step k, a superset of
+        // what the solution can touch, so no violated obstacle is ever added
+        auto filter_start = std::chrono::high_resolution_clock::now();
+        std::vector<double> reach = reachableDistance(s, x_start[3]);
+        std::vector<std::pair<double, double>> centers(s.N, std::make_pair(x_start[0], x_start[1]));
+        std::vector<std::vector<int>> per_step = filterObstacles(grid, s, centers, reach);
+        std::chrono::duration<double> filter = std::chrono::high_resolution_clock::now() - filter_start;
+        std::cout << "Filtered the map in " << filter.count() << " seconds" << std::endl;
+
+        SolveStats reach_stats = solveOnMap(env, s, grid, per_step, x_start, x_goal);
+        printStats("reach", reach_stats);
+
+        // Corridor around the previous solution, padded by one step of travel;
+        // obstacles it misses are picked up by the violation check
+        if (!reach_stats.trajectory.empty()) {
+            filter_start = std::chrono::high_resolution_clock::now();
+            std::vector<double> pads(s.N, s.T * s.v_max);
+            std::vector<std::vector<int>> corridor = filterObstacles(grid, s, reach_stats.trajectory, pads);
+            filter = std::chrono::high_resolution_clock::now() - filter_start;
+            std::cout << "Filtered the corridor in " << filter.count() << " seconds" << std::endl;
+            printStats("corridor", solveOnMap(env, s, grid, corridor, x_start, x_goal));
+        }
+
+        if (full) {
+            std::vector<int> all(obstacles.size());
+            for (size_t i = 0; i < all.size(); ++i) {
+                all[i] = (int) i;
+            }
+            std::vector<std::vector<int>> every_step(s.N, all);
+            printStats("full", solveOnMap(env, s, grid, every_step, x_start, x_goal));
+        }
+    } catch (GRBException& e) {
+        std::cerr << "Error code = " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Exception during optimization." << std::endl;
+    }
+    return 0;
+}
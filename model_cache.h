@@ -0,0 +1,88 @@
+//
+// On-disk cache of built NMPC models, keyed by a hash of NmpcStructure.
+//
+// The cached file holds the model with the zero placeholders from
+// buildNmpcModel. A process that finds it reads it back and only patches the
+// numeric data (x0, goal, obstacles) through the NmpcIndex maps.
+//
+#ifndef GUROBI_EX_MODEL_CACHE_H
+#define GUROBI_EX_MODEL_CACHE_H
+
+#include "gurobi_c++.h"
+#include "nmpc_model.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+// FNV-1a, so the key is the same across compilers and runs (std::hash is not)
+inline std::string structureHash(const NmpcStructure& s) {
+    std::ostringstream key;
+    key.precision(17);
+    key << "nmpc1 " << s.N << " " << s.T << " " << s.L << " " << s.num_obstacles << " " << s.margin;
+    for (int i = 0; i < 4; ++i) key << " " << s.Q[i] << " " << s.Q_f[i];
+    for (int i = 0; i < 2; ++i) key << " " << s.R[i];
+    key << " " << s.steer_min << " " << s.steer_max << " " << s.a_min << " " << s.a_max
+        << " " << s.v_min << " " << s.v_max;
+
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : key.str()) {
+        h ^= (unsigned char) c;
+        h *= 1099511628211ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) h);
+    return hex;
+}
+
+inline std::string cachePath(const std::string& dir, const NmpcStructure& s) {
+    return dir + "/nmpc_N" + std::to_string(s.N) + "_obs" + std::to_string(s.num_obstacles) +
+           "_" + structureHash(s) + ".mps";
+}
+
+// Read the cached model for this structure, or build it and write it to the
+// cache. hit tells which of the two happened.
+inline std::unique_ptr<GRBModel> loadOrBuildModel(GRBEnv& env, const NmpcStructure& s,
+                                                  const std::string& dir, bool& hit) {
+    std::string path = cachePath(dir, s);
+    std::ifstream file(path.c_str());
+    if (file.good()) {
+        file.close();
+        try {
+            std::unique_ptr<GRBModel> model(new GRBModel(env, path));
+            if (matchesStructure(*model, s)) {
+                hit = true;
+                return model;
+            }
+            std::cerr << "Ignoring stale cache entry " << path << std::endl;
+        } catch (GRBException& e) {
+            std::cerr << "Ignoring unreadable cache entry " << path << ": " << e.getMessage() << std::endl;
+        }
+    }
+
+    hit = false;
+    std::unique_ptr<GRBModel> model(new GRBModel(env));
+    buildNmpcModel(*model, s);
+
+    // Write under a unique temporary name and rename it into place, so readers
+    // never see a half-written entry. Gurobi picks the format from the extension.
+    long long stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string tmp = path + "." + std::to_string(stamp) + ".tmp.mps";
+    try {
+        model->write(tmp);
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+        }
+    } catch (GRBException& e) {
+        std::remove(tmp.c_str());
+        std::cerr << "Cannot write cache entry " << path << ": " << e.getMessage() << std::endl;
+    }
+    return model;
+}
+
+#endif // GUROBI_EX_MODEL_CACHE_H
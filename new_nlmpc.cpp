@@ -1,4 +1,5 @@
 #include "gurobi_c++.h"
+#include "param_profile.h"
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -8,7 +9,7 @@ struct Obstacle {
     double x, y, radius;
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         GRBEnv env = GRBEnv(true);
         env.start();
@@ -20,6 +21,7 @@ int main() {
         env.set("Threads", "0");
         env.set("PreSolve", "2");
         env.set("Cuts", "2");
+        env.set("FuncNonlinear", "1");
 
         const int N = 20; // Prediction horizon
         double T = 0.1; // Time step
@@ -45,6 +47,10 @@ int main() {
                 {2, 2, 1}
         };
 
+        // Tuned values from tune_params take precedence over the defaults above
+        std::string problem_class = problemClass("new_mpc", N, (int) obstacles.size());
+        loadParamProfile(env, problem_class);
+
         GRBModel model = GRBModel(env);
 
         // Define state and control variables
@@ -117,7 +123,7 @@ int main() {
 
         // Set NonConvex parameter for non-convex quadratic optimization
         // model.set(GRB_IntParam_NonConvex, 2);
-        model.set(GRB_IntParam_FuncNonlinear, 1);
+        // FuncNonlinear is set on the env above so a profile can override it
 
         auto start = std::chrono::high_resolution_clock::now();
 
@@ -128,6 +134,11 @@ int main() {
         std::chrono::duration<double> elapsed = end - start;
         std::cout << "Optimization time: " << elapsed.count() << " seconds" << std::endl;
 
+        // Record the instance for offline tuning: new_mpc <record_dir>
+        if (argc > 1) {
+            recordInstance(model, argv[1], problem_class, N, (int) obstacles.size(), elapsed.count());
+        }
+
         // Output the results
         if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
             std::cout << "Optimal path found!" << std::endl;
@@ -1,10 +1,11 @@
 #include "gurobi_c++.h"
+#include "param_profile.h"
 #include <iostream>
 #include <vector>
 #include <cmath>
 #include <chrono>
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         GRBEnv env = GRBEnv(true);
         env.start();
@@ -17,6 +18,7 @@ int main() {
         env.set("Threads", "0");  // Use all available threads
         env.set("PreSolve", "2");  // Aggressive presolve
         env.set("Cuts", "2");  // Aggressive cut generation
+        env.set("FuncNonlinear", "1");
 
         int N = 10; // Prediction horizon
         double T = 0.1; // Time step
@@ -37,6 +39,10 @@ int main() {
         double a_max = 3.0;
         double a_min = -3.0;
 
+        // Tuned values from tune_params take precedence over the defaults above
+        std::string problem_class = problemClass("nlmpc", N, 0);
+        loadParamProfile(env, problem_class);
+
         GRBModel model = GRBModel(env);
 
         // Define state and control variables
@@ -102,9 +108,8 @@ int main() {
 
         // Optimize the model
         //model.optimize();
-        // Approach 1) Set FuncNonlinear parameter
+        // Approach 1) FuncNonlinear is set on the env above so a profile can override it
         //model.set(GRB_IntParam_NonConvex, 2);
-        model.set(GRB_IntParam_FuncNonlinear, 1);
         // Optimize the model and print solution
         model.optimize();
 
@@ -112,6 +117,11 @@ int main() {
         std::chrono::duration<double> elapsed = end - start;
         std::cout << "Optimization time: " << elapsed.count() << " seconds" << std::endl;
 
+        // Record the instance for offline tuning: nlmpc <record_dir>
+        if (argc > 1) {
+            recordInstance(model, argv[1], problem_class, N, 0, elapsed.count());
+        }
+
         // Output the results
         if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
             std::cout << "Optimal solution found!" << std::endl;
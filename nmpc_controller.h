@@ -0,0 +1,125 @@
+//
+// Persistent NMPC for a live loop. The model is built once; every tick only
+// patches x0, the goal and the obstacles (nmpc_model.h) and re-solves, warm
+// started from the previous solution shifted by one step.
+//
+#ifndef GUROBI_EX_NMPC_CONTROLLER_H
+#define GUROBI_EX_NMPC_CONTROLLER_H
+
+#include "gurobi_c++.h"
+#include "nmpc_model.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class NmpcController {
+public:
+    NmpcController(GRBEnv& env, const NmpcStructure& s)
+            : s_(s), idx_(s), model_(new GRBModel(env)) {
+        buildNmpcModel(*model_, s_);
+        h_ = getHandles(*model_);
+        obstacles_.assign(s_.num_obstacles, Obstacle{0, 0, 0});
+    }
+
+    // Take over a model from loadOrBuildModel (model_cache.h)
+    NmpcController(const NmpcStructure& s, std::unique_ptr<GRBModel> model)
+            : s_(s), idx_(s), model_(std::move(model)) {
+        h_ = getHandles(*model_);
+        obstacles_.assign(s_.num_obstacles, Obstacle{0, 0, 0});
+    }
+
+    void setInitialState(const double x0[4]) {
+        ::setInitialState(*model_, h_, s_, x0);
+    }
+
+    void setGoal(const double goal[4]) {
+        ::setGoal(*model_, h_, s_, goal);
+    }
+
+    void setObstacles(const std::vector<Obstacle>& obstacles) {
+        ::setObstacles(*model_, h_, s_, obstacles);
+        obstacles_ = obstacles;
+    }
+
+    // Move or resize one obstacle: 2 * N right-hand sides and N QCRHS values
+    void updateObstacle(int j, const Obstacle& o) {
+        if (j < 0 || j >= s_.num_obstacles) {
+            throw std::out_of_range("updateObstacle: no obstacle " + std::to_string(j));
+        }
+        obstacles_[j] = o;
+        double r2 = (o.radius + s_.margin) * (o.radius + s_.margin);
+        for (int k = 0; k < s_.N; ++k) {
+            h_.constrs[idx_.dxRow(k, j)].set(GRB_DoubleAttr_RHS, -o.x);
+            h_.constrs[idx_.dyRow(k, j)].set(GRB_DoubleAttr_RHS, -o.y);
+            h_.qconstrs[idx_.clearance(k, j)].set(GRB_DoubleAttr_QCRHS, r2);
+        }
+    }
+
+    // Solve and return the status. After a solution exists, the next solve
+    // starts from it shifted one step ahead, the usual receding-horizon guess.
+    int solve() {
+        if (has_solution_) {
+            setShiftedStart();
+        } else {
+            start_.clear();
+        }
+        model_->optimize();
+        has_solution_ = model_->get(GRB_IntAttr_SolCount) > 0;
+        if (has_solution_) {
+            double* x = model_->get(GRB_DoubleAttr_X, h_.vars.data(), (int) h_.vars.size());
+            last_x_.assign(x, x + h_.vars.size());
+            delete[] x;
+        }
+        return model_->get(GRB_IntAttr_Status);
+    }
+
+    bool hasSolution() const { return has_solution_; }
+
+    // Start vector given to the last solve, empty if it started cold
+    const std::vector<double>& start() const { return start_; }
+
+    // Predicted state i (x, y, theta, v) at step k and control i (steer, a) at step k
+    double state(int k, int i) const { return last_x_[idx_.x(k) + i]; }
+    double control(int k, int i) const { return last_x_[idx_.steer(k) + i]; }
+
+    const NmpcStructure& structure() const { return s_; }
+    GRBModel& model() { return *model_; }
+
+private:
+    void setShiftedStart() {
+        const int N = s_.N;
+        std::vector<double>& start = start_;
+        start.assign(last_x_.size(), 0);
+        for (int k = 0; k <= N; ++k) {
+            int from = std::min(k + 1, N);
+            for (int i = 0; i < 4; ++i) {
+                start[idx_.x(k) + i] = last_x_[idx_.x(from) + i];
+            }
+        }
+        for (int k = 0; k < N; ++k) {
+            int from = std::min(k + 1, N - 1);
+            for (int i = 0; i < 5; ++i) {
+                start[idx_.steer(k) + i] = last_x_[idx_.steer(from) + i];
+            }
+            // Offsets follow the shifted position and the current obstacle centers
+            for (int j = 0; j < s_.num_obstacles; ++j) {
+                start[idx_.dx(k, j)] = start[idx_.x(k)] - obstacles_[j].x;
+                start[idx_.dy(k, j)] = start[idx_.y(k)] - obstacles_[j].y;
+            }
+        }
+        model_->set(GRB_DoubleAttr_Start, h_.vars.data(), start.data(), (int) start.size());
+    }
+
+    NmpcStructure s_;
+    NmpcIndex idx_;
+    std::unique_ptr<GRBModel> model_;
+    NmpcHandles h_;
+    std::vector<Obstacle> obstacles_;
+    std::vector<double> last_x_;
+    std::vector<double> start_;
+    bool has_solution_ = false;
+};
+
+#endif // GUROBI_EX_NMPC_CONTROLLER_H
@@ -0,0 +1,157 @@
+//
+// Live-loop benchmark for NmpcController (nmpc_controller.h).
+//
+// Usage: nmpc_loop [ticks] [obstacles]
+//
+// Each tick the obstacles drift a little, the goal moves and x0 becomes the
+// predicted next state. The persistent controller patches its model in place;
+// the baseline builds a fresh model every tick like new_mpc does. Both solve
+// the same problems and the per-tick update/rebuild and solve times are printed.
+// Both timed setup sections end with update() so the pending changes are
+// applied there and not inside optimize. The rebuilt model gets the same
+// shifted start vector as the controller, so the solve columns are comparable;
+// the rebuilt model is also solved cold to show what the warm start is worth.
+//
+#include "gurobi_c++.h"
+#include "nmpc_controller.h"
+#include "nmpc_model.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+int main(int argc, char* argv[]) {
+    int ticks = argc > 1 ? std::atoi(argv[1]) : 20;
+    int num_obstacles = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    try {
+        GRBEnv env = GRBEnv(true);
+        env.set("OutputFlag", "0");
+        env.start();
+
+        // Gurobi parameters
+        env.set("MIPFocus", "1");
+        env.set("MIPGap", "0.01");
+        env.set("TimeLimit", "60");
+        env.set("Threads", "0");
+        env.set("PreSolve", "2");
+        env.set("Cuts", "2");
+        env.set("FuncNonlinear", "1");
+
+        NmpcStructure s;
+        s.N = 20;
+        s.num_obstacles = num_obstacles;
+        s.margin = 0.3;
+
+        // Obstacles scattered around the path, away from the start
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> pos(-10, 15);
+        std::uniform_real_distribution<double> rad(0.2, 0.5);
+        std::normal_distribution<double> drift(0, 0.05);
+        std::vector<Obstacle> obstacles;
+        while ((int) obstacles.size() < num_obstacles) {
+            Obstacle o = {pos(rng), pos(rng), rad(rng)};
+            if (std::hypot(o.x, o.y) > o.radius + s.margin + 1) {
+                obstacles.push_back(o);
+            }
+        }
+
+        double x0[4] = {0, 0, M_PI_4, 0};
+        double goal[4] = {5, 5, M_PI_4, 0};
+
+        auto build_start = Clock::now();
+        NmpcController controller(env, s);
+        std::cout << "Initial build: " << seconds(build_start) << " seconds" << std::endl;
+
+        double update_total = 0, rebuild_total = 0, solve_total = 0, rebuild_solve_total = 0;
+        double cold_solve_total = 0;
+        int done = 0;
+        for (int t = 0; t < ticks; ++t) {
+            for (auto& o : obstacles) {
+                o.x += drift(rng);
+                o.y += drift(rng);
+            }
+            goal[0] += 0.1;
+            goal[1] += 0.05;
+
+            // Persistent model: patch and re-solve
+            auto update_start = Clock::now();
+            controller.setInitialState(x0);
+            controller.setGoal(goal);
+            controller.setObstacles(obstacles);
+            controller.model().update();
+            double update = seconds(update_start);
+
+            auto solve_start = Clock::now();
+            int status = controller.solve();
+            double solve = seconds(solve_start);
+
+            // Baseline: throw the model away and build it again
+            auto rebuild_start = Clock::now();
+            GRBModel model = GRBModel(env);
+            buildNmpcModel(model, s);
+            NmpcHandles h = getHandles(model);
+            setInitialState(model, h, s, x0);
+            setGoal(model, h, s, goal);
+            setObstacles(model, h, s, obstacles);
+            model.update();
+            double rebuild = seconds(rebuild_start);
+
+            // Cold solve first, then the same model again from the controller's start
+            auto cold_start = Clock::now();
+            model.optimize();
+            double cold_solve = seconds(cold_start);
+
+            auto rebuild_solve_start = Clock::now();
+            model.reset();
+            const std::vector<double>& warm = controller.start();
+            if (!warm.empty()) {
+                model.set(GRB_DoubleAttr_Start, h.vars.data(), warm.data(), (int) warm.size());
+            }
+            model.optimize();
+            double rebuild_solve = seconds(rebuild_solve_start);
+
+            std::cout << "Tick " << t << ": update " << update * 1e3 << " ms, solve " << solve * 1e3
+                      << " ms | rebuild " << rebuild * 1e3 << " ms, solve " << rebuild_solve * 1e3
+                      << " ms (cold " << cold_solve * 1e3 << " ms) | status " << status << std::endl;
+            update_total += update;
+            solve_total += solve;
+            rebuild_total += rebuild;
+            rebuild_solve_total += rebuild_solve;
+            cold_solve_total += cold_solve;
+            done++;
+
+            if (!controller.hasSolution()) {
+                std::cout << "No solution, stopping." << std::endl;
+                break;
+            }
+            // The plant follows the prediction
+            for (int i = 0; i < 4; ++i) {
+                x0[i] = controller.state(1, i);
+            }
+        }
+
+        if (done > 0) {
+            std::cout << "Average per tick: update " << update_total / done * 1e3 << " ms + solve "
+                      << solve_total / done * 1e3 << " ms, rebuild " << rebuild_total / done * 1e3
+                      << " ms + solve " << rebuild_solve_total / done * 1e3 << " ms (cold "
+                      << cold_solve_total / done * 1e3 << " ms)" << std::endl;
+        }
+    } catch (GRBException& e) {
+        std::cerr << "Error code = " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Exception during optimization." << std::endl;
+    }
+    return 0;
+}
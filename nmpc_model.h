@@ -0,0 +1,259 @@
+//
+// The new_mpc kinematic bicycle NMPC, built so that every piece of per-run data
+// (x0, goal, obstacle positions) lives in a right-hand side or a linear
+// objective coefficient. A built or loaded model can then be patched in place
+// instead of being rebuilt.
+//
+#ifndef GUROBI_EX_NMPC_MODEL_H
+#define GUROBI_EX_NMPC_MODEL_H
+
+#include "gurobi_c++.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Obstacle {
+    double x, y, radius;
+};
+
+// Everything that fixes the shape and the coefficients of the model. Two
+// problems with equal structure only differ in x0, the goal and the obstacles.
+struct NmpcStructure {
+    int N = 20; // Prediction horizon
+    double T = 0.1; // Time step
+    double L = 2.0; // Wheelbase of the vehicle
+    int num_obstacles = 1;
+    double margin = 1; // Clearance added to every obstacle radius
+
+    // Diagonal weights for the cost function
+    double Q[4] = {1, 1, 0.1, 0.1};
+    double R[2] = {0.1, 0.1};
+    double Q_f[4] = {10, 10, 1, 1};
+
+    // Control and speed limits
+    double steer_min = -M_PI / 4, steer_max = M_PI / 4;
+    double a_min = -2.0, a_max = 2.0;
+    double v_min = 0, v_max = 10;
+};
+
+// Logical (variable, step) -> column and (constraint, step) -> row maps. The
+// builder adds everything in exactly this order, so the maps also hold for a
+// model read back from a file written by that builder.
+struct NmpcIndex {
+    int N, M;
+
+    NmpcIndex(const NmpcStructure& s) : N(s.N), M(s.num_obstacles) {}
+
+    // Columns: states per step, controls and trig values per step, obstacle offsets
+    int x(int k) const { return 4 * k; }
+    int y(int k) const { return 4 * k + 1; }
+    int theta(int k) const { return 4 * k + 2; }
+    int v(int k) const { return 4 * k + 3; }
+    int steer(int k) const { return 4 * (N + 1) + 5 * k; }
+    int a(int k) const { return steer(k) + 1; }
+    int cosTheta(int k) const { return steer(k) + 2; }
+    int sinTheta(int k) const { return steer(k) + 3; }
+    int tanSteer(int k) const { return steer(k) + 4; }
+    int dx(int k, int j) const { return 4 * (N + 1) + 5 * N + 2 * (k * M + j); }
+    int dy(int k, int j) const { return dx(k, j) + 1; }
+    int numVars() const { return 4 * (N + 1) + 5 * N + 2 * N * M; }
+
+    // Linear rows: initial state, speed dynamics, obstacle offsets
+    int init(int i) const { return i; }
+    int speed(int k) const { return 4 + k; }
+    int dxRow(int k, int j) const { return 4 + N + 2 * (k * M + j); }
+    int dyRow(int k, int j) const { return dxRow(k, j) + 1; }
+    int numConstrs() const { return 4 + N + 2 * N * M; }
+
+    // Quadratic rows: x, y, theta dynamics, then obstacle clearance
+    int dynamics(int k, int i) const { return 3 * k + i; }
+    int clearance(int k, int j) const { return 3 * N + k * M + j; }
+    int numQConstrs() const { return 3 * N + N * M; }
+
+    int numGenConstrs() const { return 3 * N; }
+};
+
+// Handles into a built or loaded model, indexed through NmpcIndex
+struct NmpcHandles {
+    std::vector<GRBVar> vars;
+    std::vector<GRBConstr> constrs;
+    std::vector<GRBQConstr> qconstrs;
+};
+
+inline NmpcHandles getHandles(GRBModel& model) {
+    NmpcHandles h;
+    GRBVar* vars = model.getVars();
+    GRBConstr* constrs = model.getConstrs();
+    GRBQConstr* qconstrs = model.getQConstrs();
+    h.vars.assign(vars, vars + model.get(GRB_IntAttr_NumVars));
+    h.constrs.assign(constrs, constrs + model.get(GRB_IntAttr_NumConstrs));
+    h.qconstrs.assign(qconstrs, qconstrs + model.get(GRB_IntAttr_NumQConstrs));
+    delete[] vars;
+    delete[] constrs;
+    delete[] qconstrs;
+    return h;
+}
+
+// True if the model has the shape the builder produces for this structure
+inline bool matchesStructure(GRBModel& model, const NmpcStructure& s) {
+    NmpcIndex idx(s);
+    return model.get(GRB_IntAttr_NumVars) == idx.numVars() &&
+           model.get(GRB_IntAttr_NumConstrs) == idx.numConstrs() &&
+           model.get(GRB_IntAttr_NumQConstrs) == idx.numQConstrs() &&
+           model.get(GRB_IntAttr_NumGenConstrs) == idx.numGenConstrs();
+}
+
+// Build the model with zero placeholders for x0, the goal and the obstacles.
+// Fill them in with setInitialState, setGoal and setObstacles.
+inline void buildNmpcModel(GRBModel& model, const NmpcStructure& s) {
+    const int N = s.N;
+    const int M = s.num_obstacles;
+    std::vector<GRBVar> x_vars(N+1), y_vars(N+1), theta_vars(N+1), v_vars(N+1);
+    std::vector<GRBVar> steer_vars(N), a_vars(N);
+    std::vector<GRBVar> cos_theta_vars(N), sin_theta_vars(N), tan_steer_vars(N);
+    std::vector<GRBVar> dx_vars(N * M), dy_vars(N * M);
+
+    // Create state, control and offset variables
+    for (int k = 0; k <= N; ++k) {
+        x_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "x_" + std::to_string(k));
+        y_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "y_" + std::to_string(k));
+        theta_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "theta_" + std::to_string(k));
+        v_vars[k] = model.addVar(s.v_min, s.v_max, 0, GRB_CONTINUOUS, "v_" + std::to_string(k));
+    }
+
+    for (int k = 0; k < N; ++k) {
+        steer_vars[k] = model.addVar(s.steer_min, s.steer_max, 0, GRB_CONTINUOUS, "steer_" + std::to_string(k));
+        a_vars[k] = model.addVar(s.a_min, s.a_max, 0, GRB_CONTINUOUS, "a_" + std::to_string(k));
+        cos_theta_vars[k] = model.addVar(-1, 1, 0, GRB_CONTINUOUS, "cos_theta_" + std::to_string(k));
+        sin_theta_vars[k] = model.addVar(-1, 1, 0, GRB_CONTINUOUS, "sin_theta_" + std::to_string(k));
+        tan_steer_vars[k] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "tan_steer_" + std::to_string(k));
+    }
+
+    for (int k = 0; k < N; ++k) {
+        for (int j = 0; j < M; ++j) {
+            std::string suffix = "_" + std::to_string(k) + "_" + std::to_string(j);
+            dx_vars[k * M + j] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "dx" + suffix);
+            dy_vars[k * M + j] = model.addVar(-GRB_INFINITY, GRB_INFINITY, 0, GRB_CONTINUOUS, "dy" + suffix);
+        }
+    }
+
+    // Initial state constraint, the right-hand sides are set by setInitialState
+    model.addConstr(x_vars[0] == 0, "init_x");
+    model.addConstr(y_vars[0] == 0, "init_y");
+    model.addConstr(theta_vars[0] == 0, "init_theta");
+    model.addConstr(v_vars[0] == 0, "init_v");
+
+    for (int k = 0; k < N; ++k) {
+        model.addConstr(v_vars[k+1] == v_vars[k] + s.T * a_vars[k], "speed_" + std::to_string(k));
+    }
+
+    // Offset from each obstacle center, dx - x == -ox keeps the center in the RHS
+    for (int k = 0; k < N; ++k) {
+        for (int j = 0; j < M; ++j) {
+            std::string suffix = "_" + std::to_string(k) + "_" + std::to_string(j);
+            model.addConstr(dx_vars[k * M + j] - x_vars[k] == 0, "off_x" + suffix);
+            model.addConstr(dy_vars[k * M + j] - y_vars[k] == 0, "off_y" + suffix);
+        }
+    }
+
+    for (int k = 0; k < N; ++k) {
+        // Trigonometric constraints using Gurobi's built-in functions
+        model.addGenConstrCos(theta_vars[k], cos_theta_vars[k], "cos_theta_" + std::to_string(k));
+        model.addGenConstrSin(theta_vars[k], sin_theta_vars[k], "sin_theta_" + std::to_string(k));
+        model.addGenConstrTan(steer_vars[k], tan_steer_vars[k], "tan_steer_" + std::to_string(k));
+
+        // Dynamics constraints
+        model.addQConstr(x_vars[k+1] == x_vars[k] + s.T * v_vars[k] * cos_theta_vars[k], "dyn_x_" + std::to_string(k));
+        model.addQConstr(y_vars[k+1] == y_vars[k] + s.T * v_vars[k] * sin_theta_vars[k], "dyn_y_" + std::to_string(k));
+        model.addQConstr(theta_vars[k+1] == theta_vars[k] + s.T * (v_vars[k] / s.L) * tan_steer_vars[k],
+                         "dyn_theta_" + std::to_string(k));
+    }
+
+    // Obstacle clearance, the squared radius is set by setObstacles
+    for (int k = 0; k < N; ++k) {
+        for (int j = 0; j < M; ++j) {
+            GRBVar dx = dx_vars[k * M + j];
+            GRBVar dy = dy_vars[k * M + j];
+            model.addQConstr(dx * dx + dy * dy >= 0, "clear_" + std::to_string(k) + "_" + std::to_string(j));
+        }
+    }
+
+    // Quadratic part of the cost, the goal-dependent linear part is set by setGoal
+    GRBQuadExpr obj = 0;
+    for (int k = 0; k < N; ++k) {
+        obj += x_vars[k] * x_vars[k] * s.Q[0] + y_vars[k] * y_vars[k] * s.Q[1] +
+               theta_vars[k] * theta_vars[k] * s.Q[2] + v_vars[k] * v_vars[k] * s.Q[3] +
+               steer_vars[k] * steer_vars[k] * s.R[0] + a_vars[k] * a_vars[k] * s.R[1];
+    }
+    obj += x_vars[N] * x_vars[N] * s.Q_f[0] + y_vars[N] * y_vars[N] * s.Q_f[1] +
+           theta_vars[N] * theta_vars[N] * s.Q_f[2] + v_vars[N] * v_vars[N] * s.Q_f[3];
+    model.setObjective(obj, GRB_MINIMIZE);
+
+    model.update();
+}
+
+inline void setInitialState(GRBModel& model, const NmpcHandles& h, const NmpcStructure& s, const double x0[4]) {
+    NmpcIndex idx(s);
+    GRBConstr rows[4];
+    for (int i = 0; i < 4; ++i) {
+        rows[i] = h.constrs[idx.init(i)];
+    }
+    model.set(GRB_DoubleAttr_RHS, rows, x0, 4);
+}
+
+// Expanding Q (x - g)^2 = Q x^2 - 2 Q g x + Q g^2 gives the linear coefficients
+// and the objective constant. Stage costs track x and y only, like new_mpc.
+inline void setGoal(GRBModel& model, const NmpcHandles& h, const NmpcStructure& s, const double goal[4]) {
+    NmpcIndex idx(s);
+    std::vector<GRBVar> vars;
+    std::vector<double> coeffs;
+    double constant = 0;
+    for (int k = 0; k < s.N; ++k) {
+        vars.push_back(h.vars[idx.x(k)]);
+        coeffs.push_back(-2 * s.Q[0] * goal[0]);
+        vars.push_back(h.vars[idx.y(k)]);
+        coeffs.push_back(-2 * s.Q[1] * goal[1]);
+        constant += s.Q[0] * goal[0] * goal[0] + s.Q[1] * goal[1] * goal[1];
+    }
+    int terminal[4] = {idx.x(s.N), idx.y(s.N), idx.theta(s.N), idx.v(s.N)};
+    for (int i = 0; i < 4; ++i) {
+        vars.push_back(h.vars[terminal[i]]);
+        coeffs.push_back(-2 * s.Q_f[i] * goal[i]);
+        constant += s.Q_f[i] * goal[i] * goal[i];
+    }
+    model.set(GRB_DoubleAttr_Obj, vars.data(), coeffs.data(), (int) vars.size());
+    model.set(GRB_DoubleAttr_ObjCon, constant);
+}
+
+inline void setObstacles(GRBModel& model, const NmpcHandles& h, const NmpcStructure& s,
+                         const std::vector<Obstacle>& obstacles) {
+    if ((int) obstacles.size() != s.num_obstacles) {
+        throw std::invalid_argument("setObstacles: expected " + std::to_string(s.num_obstacles) +
+                                    " obstacles, got " + std::to_string(obstacles.size()));
+    }
+    NmpcIndex idx(s);
+    std::vector<GRBConstr> rows;
+    std::vector<double> rhs;
+    std::vector<GRBQConstr> qrows;
+    std::vector<double> qrhs;
+    for (int k = 0; k < s.N; ++k) {
+        for (int j = 0; j < s.num_obstacles; ++j) {
+            const Obstacle& o = obstacles[j];
+            rows.push_back(h.constrs[idx.dxRow(k, j)]);
+            rhs.push_back(-o.x);
+            rows.push_back(h.constrs[idx.dyRow(k, j)]);
+            rhs.push_back(-o.y);
+            qrows.push_back(h.qconstrs[idx.clearance(k, j)]);
+            qrhs.push_back((o.radius + s.margin) * (o.radius + s.margin));
+        }
+    }
+    if (!rows.empty()) {
+        model.set(GRB_DoubleAttr_RHS, rows.data(), rhs.data(), (int) rows.size());
+        for (size_t i = 0; i < qrows.size(); ++i) {
+            qrows[i].set(GRB_DoubleAttr_QCRHS, qrhs[i]);
+        }
+    }
+}
+
+#endif // GUROBI_EX_NMPC_MODEL_H
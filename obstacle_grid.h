@@ -0,0 +1,229 @@
+//
+// Uniform grid over circular obstacles, used to keep only the obstacles near
+// the predicted corridor as constraints instead of every obstacle at every step.
+//
+// Maps are either text files of circles ("x y radius" per line) or binary
+// occupancy grids, which are memory-mapped and turned into one circle per
+// occupied cell:
+//
+//   offset  0  char     magic[4]    "OGRD"
+//   offset  4  int32    width
+//   offset  8  int32    height
+//   offset 12  double   resolution
+//   offset 20  double   origin_x
+//   offset 28  double   origin_y
+//   offset 36  uint8    cells[width * height]   row-major, nonzero = occupied
+//
+// The header is packed (no padding), native byte order.
+//
+#ifndef GUROBI_EX_OBSTACLE_GRID_H
+#define GUROBI_EX_OBSTACLE_GRID_H
+
+#include "nmpc_model.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class ObstacleGrid {
+public:
+    ObstacleGrid(const std::vector<Obstacle>& obstacles, double cell_size)
+            : obstacles_(obstacles), cell_(cell_size), stamp_(0) {
+        min_x_ = min_y_ = 0;
+        double max_x = 0, max_y = 0;
+        for (size_t i = 0; i < obstacles_.size(); ++i) {
+            const Obstacle& o = obstacles_[i];
+            if (i == 0 || o.x - o.radius < min_x_) min_x_ = o.x - o.radius;
+            if (i == 0 || o.y - o.radius < min_y_) min_y_ = o.y - o.radius;
+            if (i == 0 || o.x + o.radius > max_x) max_x = o.x + o.radius;
+            if (i == 0 || o.y + o.radius > max_y) max_y = o.y + o.radius;
+        }
+        nx_ = std::max(1, (int) std::ceil((max_x - min_x_) / cell_) + 1);
+        ny_ = std::max(1, (int) std::ceil((max_y - min_y_) / cell_) + 1);
+
+        // Bucket every obstacle into all cells its bounding box touches (CSR layout)
+        std::vector<int> count(nx_ * ny_ + 1, 0);
+        forEachCell(true, count);
+        for (int c = 0; c < nx_ * ny_; ++c) {
+            count[c + 1] += count[c];
+        }
+        cell_start_ = count;
+        cell_items_.resize(count[nx_ * ny_]);
+        forEachCell(false, count);
+        seen_.assign(obstacles_.size(), 0);
+    }
+
+    const std::vector<Obstacle>& obstacles() const { return obstacles_; }
+
+    // Append the obstacles whose circle comes within pad of (x, y)
+    void query(double x, double y, double pad, std::vector<int>& out) const {
+        if (++stamp_ == 0) {
+            std::fill(seen_.begin(), seen_.end(), 0);
+            stamp_ = 1;
+        }
+        int cx0 = clampX(x - pad), cx1 = clampX(x + pad);
+        int cy0 = clampY(y - pad), cy1 = clampY(y + pad);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                int c = cy * nx_ + cx;
+                for (int i = cell_start_[c]; i < cell_start_[c + 1]; ++i) {
+                    int id = cell_items_[i];
+                    if (seen_[id] == stamp_) continue;
+                    seen_[id] = stamp_;
+                    const Obstacle& o = obstacles_[id];
+                    double reach = pad + o.radius;
+                    if ((o.x - x) * (o.x - x) + (o.y - y) * (o.y - y) <= reach * reach) {
+                        out.push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    int clampX(double x) const { return std::min(nx_ - 1, std::max(0, (int) std::floor((x - min_x_) / cell_))); }
+    int clampY(double y) const { return std::min(ny_ - 1, std::max(0, (int) std::floor((y - min_y_) / cell_))); }
+
+    // First pass counts items per cell, second pass fills them in
+    void forEachCell(bool counting, std::vector<int>& cursor) {
+        for (size_t id = 0; id < obstacles_.size(); ++id) {
+            const Obstacle& o = obstacles_[id];
+            for (int cy = clampY(o.y - o.radius); cy <= clampY(o.y + o.radius); ++cy) {
+                for (int cx = clampX(o.x - o.radius); cx <= clampX(o.x + o.radius); ++cx) {
+                    int c = cy * nx_ + cx;
+                    if (counting) {
+                        cursor[c + 1]++;
+                    } else {
+                        cell_items_[cursor[c]++] = (int) id;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Obstacle> obstacles_;
+    double min_x_, min_y_, cell_;
+    int nx_, ny_;
+    std::vector<int> cell_start_;
+    std::vector<int> cell_items_;
+    mutable std::vector<unsigned> seen_;
+    mutable unsigned stamp_;
+};
+
+inline std::vector<Obstacle> loadCircles(const std::string& path) {
+    std::ifstream file(path.c_str());
+    if (!file.good()) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::vector<Obstacle> obstacles;
+    Obstacle o;
+    while (file >> o.x >> o.y >> o.radius) {
+        obstacles.push_back(o);
+    }
+    return obstacles;
+}
+
+inline std::vector<Obstacle> loadOccupancyGrid(const std::string& path) {
+    const size_t header_size = 36;
+
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    size_t size = (size_t) st.st_size;
+    void* mapped = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path);
+    }
+    const char* data = static_cast<const char*>(mapped);
+#else
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file.good()) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t size = buffer.size();
+    const char* data = buffer.data();
+#endif
+
+    std::vector<Obstacle> obstacles;
+    int32_t width = 0, height = 0;
+    double resolution = 0, origin_x = 0, origin_y = 0;
+    bool valid = size >= header_size && std::memcmp(data, "OGRD", 4) == 0;
+    if (valid) {
+        std::memcpy(&width, data + 4, sizeof(width));
+        std::memcpy(&height, data + 8, sizeof(height));
+        std::memcpy(&resolution, data + 12, sizeof(resolution));
+        std::memcpy(&origin_x, data + 20, sizeof(origin_x));
+        std::memcpy(&origin_y, data + 28, sizeof(origin_y));
+        valid = width > 0 && height > 0 && size >= header_size + (size_t) width * height &&
+                resolution > 0 && std::isfinite(resolution) && std::isfinite(origin_x) &&
+                std::isfinite(origin_y);
+    }
+    if (valid) {
+        const uint8_t* cells = reinterpret_cast<const uint8_t*>(data + header_size);
+        double radius = resolution * std::sqrt(0.5);  // Circumscribes the cell
+        for (int r = 0; r < height; ++r) {
+            for (int c = 0; c < width; ++c) {
+                if (cells[(size_t) r * width + c]) {
+                    obstacles.push_back({origin_x + (c + 0.5) * resolution,
+                                         origin_y + (r + 0.5) * resolution, radius});
+                }
+            }
+        }
+    }
+
+#ifndef _WIN32
+    munmap(mapped, size);
+#endif
+    if (!valid) {
+        throw std::runtime_error(path + " is not an occupancy grid");
+    }
+    return obstacles;
+}
+
+// Upper bound on how far the vehicle can be from x0 after k steps, for k = 0..N
+inline std::vector<double> reachableDistance(const NmpcStructure& s, double v0) {
+    std::vector<double> reach(s.N + 1, 0);
+    double v = v0;
+    for (int k = 0; k < s.N; ++k) {
+        reach[k + 1] = reach[k] + s.T * std::min(v, s.v_max);
+        v += s.T * s.a_max;
+    }
+    return reach;
+}
+
+// Obstacles that can matter at each step: within pads[k] (+ radius + margin)
+// of centers[k]. With the previous trajectory as centers this is the corridor
+// filter; with x0 everywhere and reachableDistance as pads it never drops an
+// obstacle the vehicle could actually reach.
+inline std::vector<std::vector<int>> filterObstacles(const ObstacleGrid& grid, const NmpcStructure& s,
+                                                     const std::vector<std::pair<double, double>>& centers,
+                                                     const std::vector<double>& pads) {
+    std::vector<std::vector<int>> per_step(s.N);
+    for (int k = 0; k < s.N; ++k) {
+        grid.query(centers[k].first, centers[k].second, pads[k] + s.margin, per_step[k]);
+    }
+    return per_step;
+}
+
+#endif // GUROBI_EX_OBSTACLE_GRID_H
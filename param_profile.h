@@ -0,0 +1,75 @@
+//
+// Parameter profiles and instance recording for the NMPC examples.
+//
+// nlmpc / new_mpc / cached_mpc load params/<class>.prm at startup when it
+// exists and, when given a record directory on the command line, record every
+// solved instance there.
+// tune_params reads that corpus and writes the profiles.
+//
+#ifndef GUROBI_EX_PARAM_PROFILE_H
+#define GUROBI_EX_PARAM_PROFILE_H
+
+#include "gurobi_c++.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// All instances of one class share the same model structure, so one
+// parameter profile is used for the whole class, e.g. "new_mpc_N20_obs1".
+inline std::string problemClass(const std::string& prefix, int N, int num_obstacles) {
+    return prefix + "_N" + std::to_string(N) + "_obs" + std::to_string(num_obstacles);
+}
+
+inline std::string profilePath(const std::string& cls) {
+    return "params/" + cls + ".prm";
+}
+
+// Override the built-in defaults with the tuned profile, if there is one.
+// Call this before creating the GRBModel, a model copies the env parameters.
+inline bool loadParamProfile(GRBEnv& env, const std::string& cls) {
+    std::string path = profilePath(cls);
+    std::ifstream file(path.c_str());
+    if (!file.good()) {
+        return false;
+    }
+    env.readParams(path);
+    std::cout << "Loaded parameter profile " << path << std::endl;
+    return true;
+}
+
+// Write <dir>/<class>_<stamp>.mps (+ .lp for reading) with a .meta sidecar and
+// append the instance to <dir>/<class>.list, the manifest read by tune_params.
+inline void recordInstance(GRBModel& model, const std::string& dir, const std::string& cls,
+                           int N, int num_obstacles, double solve_time) {
+    long long stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string name = cls + "_" + std::to_string(stamp);
+    std::string base = dir + "/" + name;
+
+    // A missing or unwritable directory must not cost the run its results
+    try {
+        model.write(base + ".mps");
+        model.write(base + ".lp");
+    } catch (GRBException& e) {
+        std::cerr << "Cannot record instance " << base << ": " << e.getMessage() << std::endl;
+        return;
+    }
+
+    int status = model.get(GRB_IntAttr_Status);
+    std::ofstream meta((base + ".meta").c_str());
+    meta << "class " << cls << "\n"
+         << "N " << N << "\n"
+         << "obstacles " << num_obstacles << "\n"
+         << "status " << status << "\n"
+         << "solve_time " << solve_time << "\n";
+    if (model.get(GRB_IntAttr_SolCount) > 0) {
+        meta << "objective " << model.get(GRB_DoubleAttr_ObjVal) << "\n";
+    }
+
+    std::ofstream list((dir + "/" + cls + ".list").c_str(), std::ios::app);
+    list << name << ".mps\n";
+    std::cout << "Recorded instance " << base << ".mps" << std::endl;
+}
+
+#endif // GUROBI_EX_PARAM_PROFILE_H
@@ -0,0 +1,282 @@
+//
+// Offline parameter tuning over a recorded instance corpus.
+//
+// Usage: tune_params <corpus_dir> <class> [workers] [time_limit]
+//
+// <corpus_dir>/<class>.list is written by nlmpc / new_mpc when they are run
+// with a record directory. Every instance is solved under each setting of a
+// grid over the parameters those executables hard-code, and Gurobi's own tuner
+// is run on the first instance as an extra candidate. MIPGap and FuncNonlinear
+// stay at the values the executables use. The best setting is written to
+// params/<class>.prm, which the executables load at startup.
+//
+// By default one candidate runs at a time with all cores (Threads=0), as the
+// executables do. With several workers each candidate gets hw / workers
+// threads, which is faster but ranks settings under fewer threads than the
+// deployed solve uses.
+//
+#include "gurobi_c++.h"
+#include "param_profile.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, std::string>> Setting;
+
+struct Score {
+    double total_time;  // Runtime summed over the corpus, unsolved count as 2 * time limit
+    int solved;
+};
+
+// Fixed for every candidate instead of being searched: MIPGap is an accuracy
+// requirement (a looser gap always wins on time), and FuncNonlinear=1 keeps the
+// exact trig constraints (a coarse piecewise-linear approximation would win on
+// time while solving different dynamics).
+static const Setting kFixed = {{"MIPGap", "0.01"}, {"FuncNonlinear", "1"}};
+
+// Gurobi defaults of the searched parameters. Every candidate lists all of them
+// explicitly, so a profile always overrides the values nlmpc / new_mpc hard-code.
+static const Setting kSearched = {{"MIPFocus", "0"}, {"Presolve", "-1"}, {"Cuts", "-1"}};
+
+static bool sameName(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower((unsigned char) a[i]) != std::tolower((unsigned char) b[i])) return false;
+    }
+    return true;
+}
+
+static bool contains(const Setting& setting, const std::string& name) {
+    for (const auto& p : setting) {
+        if (sameName(p.first, name)) return true;
+    }
+    return false;
+}
+
+// Fill in the searched parameters the candidate leaves at their default and
+// drop the fixed and per-run (Threads, TimeLimit, Tune*) ones
+static Setting completeSetting(const Setting& candidate) {
+    Setting full = kSearched;
+    for (const auto& p : candidate) {
+        if (contains(kFixed, p.first) || sameName(p.first, "Threads") || sameName(p.first, "TimeLimit") ||
+            sameName(p.first.substr(0, 4), "Tune")) {
+            continue;
+        }
+        bool searched = false;
+        for (auto& q : full) {
+            if (sameName(q.first, p.first)) {
+                q.second = p.second;
+                searched = true;
+            }
+        }
+        if (!searched) {
+            full.push_back(p);
+        }
+    }
+    return full;
+}
+
+static std::string describe(const Setting& setting) {
+    std::string s;
+    for (const auto& p : setting) {
+        s += p.first + "=" + p.second + " ";
+    }
+    return s;
+}
+
+static std::vector<Setting> buildGrid() {
+    const char* mip_focus[] = {"0", "1", "2", "3"};
+    const char* presolve[] = {"-1", "1", "2"};
+    const char* cuts[] = {"-1", "0", "2"};
+
+    std::vector<Setting> grid;
+    for (const char* f : mip_focus) {
+        for (const char* p : presolve) {
+            for (const char* c : cuts) {
+                grid.push_back({{"MIPFocus", f}, {"Presolve", p}, {"Cuts", c}});
+            }
+        }
+    }
+    return grid;
+}
+
+static std::vector<std::string> readCorpus(const std::string& dir, const std::string& cls) {
+    std::vector<std::string> instances;
+    std::ifstream list((dir + "/" + cls + ".list").c_str());
+    std::string name;
+    while (std::getline(list, name)) {
+        if (!name.empty()) {
+            instances.push_back(dir + "/" + name);
+        }
+    }
+    return instances;
+}
+
+// Parse a .prm file ("Name value" per line, '#' comments) into a setting
+static Setting readSetting(const std::string& path) {
+    Setting setting;
+    std::ifstream file(path.c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream in(line);
+        std::string name, value;
+        if (in >> name >> value) {
+            setting.push_back(std::make_pair(name, value));
+        }
+    }
+    return setting;
+}
+
+// Each call creates its own env: a GRBEnv must not be shared between threads.
+static Score evaluate(const std::vector<std::string>& instances, const Setting& setting,
+                      int threads, double time_limit) {
+    GRBEnv env = GRBEnv(true);
+    env.set("OutputFlag", "0");
+    env.start();
+    env.set("Threads", std::to_string(threads));
+    env.set("TimeLimit", std::to_string(time_limit));
+    for (const auto& p : kFixed) {
+        env.set(p.first, p.second);
+    }
+    for (const auto& p : setting) {
+        env.set(p.first, p.second);
+    }
+
+    Score score = {0, 0};
+    for (const auto& path : instances) {
+        GRBModel model = GRBModel(env, path);
+        model.optimize();
+        if (model.get(GRB_IntAttr_Status) == GRB_OPTIMAL) {
+            score.total_time += model.get(GRB_DoubleAttr_Runtime);
+            score.solved++;
+        } else {
+            score.total_time += 2 * time_limit;
+        }
+    }
+    return score;
+}
+
+// Run Gurobi's tuner on one instance and return its best setting
+static Setting runTuner(const std::string& instance, const std::string& dir, const std::string& cls,
+                        double tune_time) {
+    GRBEnv env = GRBEnv(true);
+    env.set("OutputFlag", "0");
+    env.start();
+
+    GRBModel model = GRBModel(env, instance);
+    for (const auto& p : kFixed) {
+        model.set(p.first, p.second);  // Parameters set before tuning are kept fixed
+    }
+    model.set(GRB_DoubleParam_TuneTimeLimit, tune_time);
+    model.set(GRB_IntParam_TuneResults, 1);
+    model.tune();
+
+    Setting setting;
+    if (model.get(GRB_IntAttr_TuneResultCount) > 0) {
+        model.getTuneResult(0);
+        std::string path = dir + "/" + cls + "_tune.prm";
+        model.write(path);
+        setting = completeSetting(readSetting(path));
+        std::remove(path.c_str());
+    }
+    return setting;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <corpus_dir> <class> [workers] [time_limit]" << std::endl;
+        return 1;
+    }
+    std::string dir = argv[1];
+    std::string cls = argv[2];
+    int hw = std::max(1, (int) std::thread::hardware_concurrency());
+    int workers = argc > 3 ? std::atoi(argv[3]) : 1;
+    double time_limit = argc > 4 ? std::atof(argv[4]) : 60;
+    workers = std::max(1, workers);
+    int threads_per_worker = workers == 1 ? 0 : std::max(1, hw / workers);
+
+    try {
+        std::vector<std::string> instances = readCorpus(dir, cls);
+        if (instances.empty()) {
+            std::cerr << "No recorded instances in " << dir << "/" << cls << ".list" << std::endl;
+            return 1;
+        }
+        std::cout << "Tuning " << cls << " over " << instances.size() << " instances" << std::endl;
+        if (workers > 1) {
+            std::cout << "Note: " << workers << " workers with " << threads_per_worker
+                      << " threads each; nlmpc / new_mpc solve with all cores (Threads=0), so the "
+                      << "ranking may not carry over" << std::endl;
+        }
+
+        std::vector<Setting> candidates = buildGrid();
+        Setting tuned = runTuner(instances[0], dir, cls, time_limit * instances.size());
+        if (!tuned.empty()) {
+            candidates.push_back(tuned);
+        }
+
+        // Workers pull candidates from a shared counter; scores are stored by index
+        std::vector<Score> scores(candidates.size(), Score{GRB_INFINITY, 0});
+        std::atomic<int> next(0);
+        std::vector<std::thread> pool;
+        for (int w = 0; w < workers; ++w) {
+            pool.push_back(std::thread([&]() {
+                for (int i = next++; i < (int) candidates.size(); i = next++) {
+                    try {
+                        scores[i] = evaluate(instances, candidates[i], threads_per_worker, time_limit);
+                    } catch (GRBException& e) {
+                        std::cerr << "Error code = " << e.getErrorCode() << " for "
+                                  << describe(candidates[i]) << std::endl;
+                        std::cerr << e.getMessage() << std::endl;
+                    }
+                }
+            }));
+        }
+        for (auto& t : pool) {
+            t.join();
+        }
+
+        int best = 0;
+        for (int i = 0; i < (int) candidates.size(); ++i) {
+            std::cout << scores[i].total_time << " s, " << scores[i].solved << "/" << instances.size()
+                      << " solved: " << describe(candidates[i]) << std::endl;
+            if (scores[i].solved > scores[best].solved ||
+                (scores[i].solved == scores[best].solved && scores[i].total_time < scores[best].total_time)) {
+                best = i;
+            }
+        }
+
+        std::string path = profilePath(cls);
+        std::ofstream profile(path.c_str());
+        if (!profile.good()) {
+            std::cerr << "Cannot write " << path << " (does params/ exist?)" << std::endl;
+            return 1;
+        }
+        profile << "# Tuned by tune_params over " << instances.size() << " instances of " << cls << "\n";
+        for (const auto& p : kFixed) {
+            profile << p.first << " " << p.second << "\n";
+        }
+        for (const auto& p : candidates[best]) {
+            profile << p.first << " " << p.second << "\n";
+        }
+        std::cout << "Best: " << describe(candidates[best]) << std::endl;
+        std::cout << "Wrote " << path << std::endl;
+    } catch (GRBException& e) {
+        std::cerr << "Error code = " << e.getErrorCode() << std::endl;
+        std::cerr << e.getMessage() << std::endl;
+    } catch (...) {
+        std::cerr << "Exception during tuning." << std::endl;
+    }
+    return 0;
+}